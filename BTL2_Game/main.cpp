@@ -6,18 +6,27 @@
 #include <cmath>
 #include <string>
 #include <sstream>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
 const int SCREEN_WIDTH = 800;
 const int SCREEN_HEIGHT = 600;
 
-void drawFilledTriangle(SDL_Renderer* renderer,
-                        SDL_Point p1, SDL_Point p2, SDL_Point p3) {
-    auto drawLine = [&](SDL_Point a, SDL_Point b) {
-        SDL_RenderDrawLine(renderer, a.x, a.y, b.x, b.y);
-    };
-
+// Walks a triangle row by row, calling drawRow(A, B) with the two edge points
+// of each row. Shared by the SDL and CPU paths so both cover the same pixels.
+template <typename DrawRow>
+void forEachTriangleRow(SDL_Point p1, SDL_Point p2, SDL_Point p3, DrawRow drawRow) {
     // Sort by y
     if (p2.y < p1.y) swap(p1, p2);
     if (p3.y < p1.y) swap(p1, p3);
@@ -43,10 +52,17 @@ void drawFilledTriangle(SDL_Renderer* renderer,
             B = interp(p2, p3, t2);
         }
 
-        drawLine(A, B);
+        drawRow(A, B);
     }
 }
 
+void drawFilledTriangle(SDL_Renderer* renderer,
+                        SDL_Point p1, SDL_Point p2, SDL_Point p3) {
+    forEachTriangleRow(p1, p2, p3, [&](SDL_Point a, SDL_Point b) {
+        SDL_RenderDrawLine(renderer, a.x, a.y, b.x, b.y);
+    });
+}
+
 
 // ===================================================
 // Draw filled circle
@@ -61,6 +77,331 @@ void drawFilledCircle(SDL_Renderer* renderer, int cx, int cy, int r) {
 }
 // ===================================================
 
+// ====================== CANVAS =====================
+// Everything the game draws goes through a Canvas. SdlCanvas issues the
+// usual per-primitive SDL calls; CpuCanvas rasterizes into a framebuffer and
+// uploads it once per frame, which is much faster when SDL itself is running
+// on its software renderer.
+class Canvas {
+public:
+    bool hasBackground = false;
+
+    virtual ~Canvas() {}
+    virtual bool loadBackground(const char* path) = 0;
+    virtual void drawBackground() = 0;
+    virtual void setColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) = 0;
+    virtual void setBlendMode(SDL_BlendMode mode) = 0;
+    virtual void clear() = 0;
+    virtual void fillRect(const SDL_Rect& rect) = 0;
+    virtual void drawRect(const SDL_Rect& rect) = 0;
+    virtual void fillCircle(int cx, int cy, int r) = 0;
+    virtual void fillTriangle(SDL_Point p1, SDL_Point p2, SDL_Point p3) = 0;
+    // Puts the finished frame into the renderer's back buffer
+    virtual void finish() = 0;
+    // Copies the current frame out as SCREEN_WIDTH x SCREEN_HEIGHT ARGB8888,
+    // false if the readback failed and dst holds garbage
+    virtual bool readPixels(Uint32* dst) = 0;
+};
+
+class SdlCanvas : public Canvas {
+public:
+    SDL_Renderer* renderer;
+    SDL_Texture* backgroundTexture = nullptr;
+
+    SdlCanvas(SDL_Renderer* renderer) : renderer(renderer) {}
+
+    ~SdlCanvas() {
+        if (backgroundTexture) SDL_DestroyTexture(backgroundTexture);
+    }
+
+    bool loadBackground(const char* path) {
+        backgroundTexture = IMG_LoadTexture(renderer, path);
+        hasBackground = backgroundTexture != nullptr;
+        return hasBackground;
+    }
+
+    void drawBackground() { SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL); }
+    void setColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) { SDL_SetRenderDrawColor(renderer, r, g, b, a); }
+    void setBlendMode(SDL_BlendMode mode) { SDL_SetRenderDrawBlendMode(renderer, mode); }
+    void clear() { SDL_RenderClear(renderer); }
+    void fillRect(const SDL_Rect& rect) { SDL_RenderFillRect(renderer, &rect); }
+    void drawRect(const SDL_Rect& rect) { SDL_RenderDrawRect(renderer, &rect); }
+    void fillCircle(int cx, int cy, int r) { drawFilledCircle(renderer, cx, cy, r); }
+    void fillTriangle(SDL_Point p1, SDL_Point p2, SDL_Point p3) { drawFilledTriangle(renderer, p1, p2, p3); }
+    void finish() {}
+
+    bool readPixels(Uint32* dst) {
+        return SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888,
+                                    dst, SCREEN_WIDTH * 4) == 0;
+    }
+};
+
+// ---- span fills, 4 pixels per step with SSE2 ----
+
+void fillSpanSolid(Uint32* dst, int n, Uint32 color) {
+    int i = 0;
+#ifdef __SSE2__
+    __m128i c = _mm_set1_epi32((int)color);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_si128((__m128i*)(dst + i), c);
+#endif
+    for (; i < n; i++) dst[i] = color;
+}
+
+// Same math as SDL's software blender: dst = premult + dst * (255 - a) / 255
+// per channel, where premult holds (a, r*a/255, g*a/255, b*a/255)
+void fillSpanBlend(Uint32* dst, int n, Uint32 premult, Uint8 inva) {
+    int i = 0;
+#ifdef __SSE2__
+    __m128i zero = _mm_setzero_si128();
+    __m128i one = _mm_set1_epi16(1);
+    __m128i inv = _mm_set1_epi16(inva);
+    __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32((int)premult), zero);
+    for (; i + 4 <= n; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv);
+        __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv);
+        // Exact x / 255 for x <= 255 * 255: (x + 1 + ((x + 1) >> 8)) >> 8
+        lo = _mm_add_epi16(lo, one);
+        hi = _mm_add_epi16(hi, one);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+        lo = _mm_add_epi16(lo, src);
+        hi = _mm_add_epi16(hi, src);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; i++) {
+        Uint32 d = dst[i];
+        Uint32 out = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            Uint32 c = ((d >> shift) & 0xFF) * inva / 255 + ((premult >> shift) & 0xFF);
+            out |= c << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+// Clips a line to the screen the way SDL_IntersectRectAndLine does (integer
+// Cohen-Sutherland). SDL clips before stepping Bresenham, so a line that
+// leaves the screen starts its pattern at the clipped endpoint.
+bool clipLineToScreen(int& x1, int& y1, int& x2, int& y2) {
+    const int left = 0, top = 0, right = SCREEN_WIDTH - 1, bottom = SCREEN_HEIGHT - 1;
+    enum { CODE_BOTTOM = 1, CODE_TOP = 2, CODE_LEFT = 4, CODE_RIGHT = 8 };
+
+    auto outCode = [&](int x, int y) {
+        int code = 0;
+        if (y < top) code |= CODE_TOP;
+        else if (y > bottom) code |= CODE_BOTTOM;
+        if (x < left) code |= CODE_LEFT;
+        else if (x > right) code |= CODE_RIGHT;
+        return code;
+    };
+
+    // Entirely inside / entirely to one side
+    if (x1 >= left && x1 <= right && x2 >= left && x2 <= right &&
+        y1 >= top && y1 <= bottom && y2 >= top && y2 <= bottom)
+        return true;
+    if ((x1 < left && x2 < left) || (x1 > right && x2 > right) ||
+        (y1 < top && y2 < top) || (y1 > bottom && y2 > bottom))
+        return false;
+
+    if (y1 == y2) {
+        x1 = max(left, min(x1, right));
+        x2 = max(left, min(x2, right));
+        return true;
+    }
+    if (x1 == x2) {
+        y1 = max(top, min(y1, bottom));
+        y2 = max(top, min(y2, bottom));
+        return true;
+    }
+
+    int code1 = outCode(x1, y1), code2 = outCode(x2, y2);
+    while (code1 || code2) {
+        if (code1 & code2) return false;
+
+        int& px = code1 ? x1 : x2;
+        int& py = code1 ? y1 : y2;
+        int code = code1 ? code1 : code2;
+        int x = 0, y = 0;
+        if (code & CODE_TOP) {
+            y = top;
+            x = x1 + ((x2 - x1) * (y - y1)) / (y2 - y1);
+        } else if (code & CODE_BOTTOM) {
+            y = bottom;
+            x = x1 + ((x2 - x1) * (y - y1)) / (y2 - y1);
+        } else if (code & CODE_LEFT) {
+            x = left;
+            y = y1 + ((y2 - y1) * (x - x1)) / (x2 - x1);
+        } else {
+            x = right;
+            y = y1 + ((y2 - y1) * (x - x1)) / (x2 - x1);
+        }
+        px = x;
+        py = y;
+        if (code1) code1 = outCode(x, y);
+        else code2 = outCode(x, y);
+    }
+    return true;
+}
+
+class CpuCanvas : public Canvas {
+public:
+    vector<Uint32> pixels; // ARGB8888, SCREEN_WIDTH * SCREEN_HEIGHT
+
+    CpuCanvas(SDL_Renderer* renderer) : renderer(renderer) {
+        pixels.assign(SCREEN_WIDTH * SCREEN_HEIGHT, 0xFF000000);
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                    SDL_TEXTUREACCESS_STREAMING,
+                                    SCREEN_WIDTH, SCREEN_HEIGHT);
+        if (!texture)
+            cerr << "Failed to create streaming texture: " << SDL_GetError() << endl;
+        else
+            // Textures with alpha default to blending, finish() wants a plain copy
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+    }
+
+    ~CpuCanvas() {
+        if (texture) SDL_DestroyTexture(texture);
+    }
+
+    bool ok() const { return texture != nullptr; }
+
+    bool loadBackground(const char* path) {
+        SDL_Surface* image = IMG_Load(path);
+        if (!image) return false;
+
+        SDL_Surface* converted = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(image);
+        if (!converted) return false;
+
+        // Scale once up front, drawing it is then a plain copy
+        background.assign(SCREEN_WIDTH * SCREEN_HEIGHT, 0);
+        SDL_Surface* target = SDL_CreateRGBSurfaceWithFormatFrom(
+            background.data(), SCREEN_WIDTH, SCREEN_HEIGHT, 32,
+            SCREEN_WIDTH * 4, SDL_PIXELFORMAT_ARGB8888);
+        SDL_SetSurfaceBlendMode(converted, SDL_BLENDMODE_NONE);
+        hasBackground = target && SDL_BlitScaled(converted, NULL, target, NULL) == 0;
+        if (target) SDL_FreeSurface(target);
+        SDL_FreeSurface(converted);
+        return hasBackground;
+    }
+
+    void drawBackground() {
+        memcpy(pixels.data(), background.data(), pixels.size() * sizeof(Uint32));
+    }
+
+    void setColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+        color = ((Uint32)a << 24) | ((Uint32)r << 16) | ((Uint32)g << 8) | b;
+        premult = ((Uint32)a << 24) | ((Uint32)(r * a / 255) << 16) |
+                  ((Uint32)(g * a / 255) << 8) | (Uint32)(b * a / 255);
+        inva = 255 - a;
+    }
+
+    void setBlendMode(SDL_BlendMode mode) { blendMode = mode; }
+
+    // Like SDL_RenderClear: ignores the blend mode
+    void clear() { fillSpanSolid(pixels.data(), pixels.size(), color); }
+
+    // SDL's software renderer grows empty rects to 1x1 (SW_QueueFillRects),
+    // e.g. the charge bar fill right after charging starts
+    void fillRect(const SDL_Rect& rect) {
+        int w = max(rect.w, 1), h = max(rect.h, 1);
+        int x0 = max(rect.x, 0), x1 = min(rect.x + w, SCREEN_WIDTH) - 1;
+        int y0 = max(rect.y, 0), y1 = min(rect.y + h, SCREEN_HEIGHT) - 1;
+        for (int y = y0; y <= y1; y++) span(x0, x1, y);
+    }
+
+    void drawRect(const SDL_Rect& rect) {
+        if (rect.w <= 0 || rect.h <= 0) return;
+        int right = rect.x + rect.w - 1, bottom = rect.y + rect.h - 1;
+        span(rect.x, right, rect.y);
+        if (bottom != rect.y) span(rect.x, right, bottom);
+        for (int y = rect.y + 1; y < bottom; y++) {
+            span(rect.x, rect.x, y);
+            if (right != rect.x) span(right, right, y);
+        }
+    }
+
+    // Same coverage as drawFilledCircle (w*w + h*h <= r*r), one span per row
+    void fillCircle(int cx, int cy, int r) {
+        for (int h = -r; h <= r; h++) {
+            int rem = r * r - h * h;
+            int w = (int)sqrt((double)rem);
+            while (w * w > rem) w--;
+            while ((w + 1) * (w + 1) <= rem) w++;
+            span(cx - w, cx + w, cy + h);
+        }
+    }
+
+    void fillTriangle(SDL_Point p1, SDL_Point p2, SDL_Point p3) {
+        forEachTriangleRow(p1, p2, p3, [this](SDL_Point a, SDL_Point b) {
+            if (a.y == b.y) span(min(a.x, b.x), max(a.x, b.x), a.y);
+            else line(a, b);
+        });
+    }
+
+    void finish() {
+        SDL_UpdateTexture(texture, NULL, pixels.data(), SCREEN_WIDTH * 4);
+        SDL_RenderCopy(renderer, texture, NULL, NULL);
+    }
+
+    bool readPixels(Uint32* dst) {
+        memcpy(dst, pixels.data(), pixels.size() * sizeof(Uint32));
+        return true;
+    }
+
+private:
+    SDL_Renderer* renderer;
+    SDL_Texture* texture = nullptr;
+    vector<Uint32> background;
+    Uint32 color = 0xFF000000, premult = 0xFF000000;
+    Uint8 inva = 0;
+    SDL_BlendMode blendMode = SDL_BLENDMODE_NONE;
+
+    // Fills x0..x1 (inclusive) on row y, clipped to the screen
+    void span(int x0, int x1, int y) {
+        if (y < 0 || y >= SCREEN_HEIGHT) return;
+        x0 = max(x0, 0);
+        x1 = min(x1, SCREEN_WIDTH - 1);
+        if (x0 > x1) return;
+
+        Uint32* row = pixels.data() + y * SCREEN_WIDTH + x0;
+        if (blendMode == SDL_BLENDMODE_BLEND && inva != 0)
+            fillSpanBlend(row, x1 - x0 + 1, premult, inva);
+        else
+            fillSpanSolid(row, x1 - x0 + 1, color);
+    }
+
+    // Bresenham, stepping the same way SDL does for its point-based lines
+    void line(SDL_Point a, SDL_Point b) {
+        if (!clipLineToScreen(a.x, a.y, b.x, b.y)) return;
+
+        int dx = abs(b.x - a.x), dy = abs(b.y - a.y);
+        int sx = a.x < b.x ? 1 : -1, sy = a.y < b.y ? 1 : -1;
+        int x = a.x, y = a.y;
+        if (dx >= dy) {
+            int d = 2 * dy - dx;
+            for (int i = 0; i <= dx; i++) {
+                span(x, x, y);
+                if (d >= 0) { y += sy; d -= 2 * dx; }
+                d += 2 * dy;
+                x += sx;
+            }
+        } else {
+            int d = 2 * dx - dy;
+            for (int i = 0; i <= dy; i++) {
+                span(x, x, y);
+                if (d >= 0) { x += sx; d -= 2 * dy; }
+                d += 2 * dx;
+                y += sy;
+            }
+        }
+    }
+};
+// ===================================================
+
 // ===================== PLAYER ======================
 class Player {
 public:
@@ -68,6 +409,8 @@ public:
     int radius = 20;
     SDL_Color color;
     bool active = false;
+    int id = -1;   // index across both teams, used by telemetry
+    int team = 0;
     
     // Direction tracking
     float dirX = 1.0f; // Default facing right
@@ -97,55 +440,264 @@ public:
         if (y > SCREEN_HEIGHT - radius) y = SCREEN_HEIGHT - radius;
     }
     
-    void drawArrow(SDL_Renderer* renderer) {
+    // Arrow head in front of the player, also used by the render check
+    void arrowPoints(SDL_Point& tip, SDL_Point& left, SDL_Point& right) const {
         int arrowStartDist = radius + 20;
         int arrowLength = 28;
 
-        int sx = x + dirX * arrowStartDist;
-        int sy = y + dirY * arrowStartDist;
         int ex = x + dirX * (arrowStartDist + arrowLength);
         int ey = y + dirY * (arrowStartDist + arrowLength);
 
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-
-        //SDL_RenderDrawLine(renderer, sx, sy, ex, ey);
-
         float angle = atan2(dirY, dirX);
         float headLength = 14.0f;
         float headWidth  = 10.0f;
 
-        SDL_Point tip = { ex, ey };
-        SDL_Point left = {
+        tip = { ex, ey };
+        left = {
             (int)(ex - headLength * cos(angle) + headWidth * sin(angle)),
             (int)(ey - headLength * sin(angle) - headWidth * cos(angle))
         };
-        SDL_Point right = {
+        right = {
             (int)(ex - headLength * cos(angle) - headWidth * sin(angle)),
             (int)(ey - headLength * sin(angle) + headWidth * cos(angle))
         };
+    }
+
+    void drawArrow(Canvas* canvas) {
+        canvas->setColor(0, 0, 0, 255);
 
-        drawFilledTriangle(renderer, tip, left, right);
+        SDL_Point tip, left, right;
+        arrowPoints(tip, left, right);
+        canvas->fillTriangle(tip, left, right);
     }
 
-    void draw(SDL_Renderer* renderer) {
+    void draw(Canvas* canvas) {
         // highlight active player
         if (active) {
-            SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
-            drawFilledCircle(renderer, x, y, radius + 3);
+            canvas->setColor(255, 255, 0, 255);
+            canvas->fillCircle(x, y, radius + 3);
         }
 
         // draw player
-        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
-        drawFilledCircle(renderer, x, y, radius);
+        canvas->setColor(color.r, color.g, color.b, 255);
+        canvas->fillCircle(x, y, radius);
 
         // draw arrow
         if (active) {
-            drawArrow(renderer);
+            drawArrow(canvas);
         }
     }
 };
 // ===================================================
 
+// ==================== TELEMETRY ====================
+struct TelemetryEvent {
+    enum Type : Uint8 { POSSESSION, SHOT, GOAL };
+
+    Uint32 time;       // SDL_GetTicks()
+    Type type;
+    Sint8 player;      // -1 when no player is involved
+    Uint8 team;
+    float x, y;
+    float charge;      // SHOT only: charge power 0..1
+    float speed;       // SHOT only: resulting ball speed
+};
+
+// Single producer / single consumer ring. The game thread pushes, the writer
+// thread drains, neither ever blocks: when full the event is dropped.
+class EventBuffer {
+public:
+    static const unsigned CAPACITY = 4096; // power of two
+
+    bool push(const TelemetryEvent& e) {
+        unsigned h = head.load(memory_order_relaxed);
+        if (h - tail.load(memory_order_acquire) == CAPACITY) {
+            dropped.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        events[h & (CAPACITY - 1)] = e;
+        head.store(h + 1, memory_order_release);
+        return true;
+    }
+
+    void drain(vector<TelemetryEvent>& out) {
+        unsigned t = tail.load(memory_order_relaxed);
+        unsigned h = head.load(memory_order_acquire);
+        for (; t != h; t++)
+            out.push_back(events[t & (CAPACITY - 1)]);
+        tail.store(t, memory_order_release);
+    }
+
+    atomic<unsigned> dropped{0};
+
+private:
+    TelemetryEvent events[CAPACITY];
+    atomic<unsigned> head{0}, tail{0};
+};
+
+// Collects possession, shot and goal events plus per-player position
+// heatmaps. Events are written as CSV by a background thread; hooks cost a
+// single branch while telemetry is disabled.
+class Telemetry {
+public:
+    static const int MAX_PLAYERS = 6;
+    static const int CELL_SIZE = 40; // heatmap grid resolution in pixels
+    static const int GRID_COLS = SCREEN_WIDTH / CELL_SIZE;
+    static const int GRID_ROWS = SCREEN_HEIGHT / CELL_SIZE;
+
+    bool enabled = false;
+    bool matchOver = false; // nothing after the final whistle is recorded
+
+    ~Telemetry() { stop(); }
+
+    bool start(const string& path) {
+        if (enabled) return true;
+
+        out.open(path.c_str());
+        if (!out) {
+            cerr << "Failed to open " << path << " for telemetry" << endl;
+            return false;
+        }
+        out << "time_ms,event,player,team,x,y,charge,speed\n";
+
+        heatmapPath = path + ".heatmap.csv";
+        for (auto& grid : heat)
+            for (auto& row : grid)
+                for (auto& cell : row) cell = 0;
+
+        quit = false;
+        matchOver = false;
+        writer = thread(&Telemetry::writerLoop, this);
+        enabled = true;
+        return true;
+    }
+
+    void stop() {
+        if (!enabled) return;
+        enabled = false;
+        {
+            lock_guard<mutex> lock(m);
+            quit = true;
+        }
+        cv.notify_one();
+        writer.join();
+        out.close();
+        writeHeatmaps();
+
+        unsigned dropped = 0;
+        for (auto& b : buffers) dropped += b->dropped.load();
+        if (dropped > 0)
+            cerr << "Telemetry dropped " << dropped << " events" << endl;
+    }
+
+    // Called once when the match ends, play on the game-over screen would
+    // otherwise skew the heatmaps and the possession log
+    void endMatch() { matchOver = true; }
+
+    // ---- hooks ----
+    void possession(const Player* p) {
+        if (!enabled || matchOver) return;
+        record(TelemetryEvent::POSSESSION, p, p->x, p->y, 0, 0);
+    }
+
+    void shot(const Player* p, float charge, float speed) {
+        if (!enabled || matchOver) return;
+        record(TelemetryEvent::SHOT, p, p->x, p->y, charge, speed);
+    }
+
+    void goal(int team, float x, float y) {
+        if (!enabled || matchOver) return;
+        TelemetryEvent e = { SDL_GetTicks(), TelemetryEvent::GOAL, -1,
+                             (Uint8)team, x, y, 0, 0 };
+        localBuffer().push(e);
+    }
+
+    // Called once per frame from the game thread
+    void samplePositions(const vector<Player>& players) {
+        if (!enabled || matchOver) return;
+        for (const auto& p : players) {
+            if (p.id < 0 || p.id >= MAX_PLAYERS) continue;
+            int col = min(p.x / CELL_SIZE, GRID_COLS - 1);
+            int row = min(p.y / CELL_SIZE, GRID_ROWS - 1);
+            heat[p.id][row][col]++;
+            heatTeam[p.id] = p.team;
+        }
+    }
+
+private:
+    vector<unique_ptr<EventBuffer>> buffers; // one per producer thread
+    mutex m;
+    condition_variable cv;
+    thread writer;
+    bool quit = false;
+    ofstream out;
+
+    // Heatmaps belong to the game thread, written once on stop()
+    Uint32 heat[MAX_PLAYERS][GRID_ROWS][GRID_COLS];
+    int heatTeam[MAX_PLAYERS] = {};
+    string heatmapPath;
+
+    void record(TelemetryEvent::Type type, const Player* p,
+                float x, float y, float charge, float speed) {
+        TelemetryEvent e = { SDL_GetTicks(), type, (Sint8)p->id,
+                             (Uint8)p->team, x, y, charge, speed };
+        localBuffer().push(e);
+    }
+
+    // The lock is only taken the first time a thread records an event
+    EventBuffer& localBuffer() {
+        static thread_local EventBuffer* buffer = nullptr;
+        if (!buffer) {
+            lock_guard<mutex> lock(m);
+            buffers.emplace_back(new EventBuffer());
+            buffer = buffers.back().get();
+        }
+        return *buffer;
+    }
+
+    void writerLoop() {
+        vector<TelemetryEvent> pending;
+        bool done = false;
+        while (!done) {
+            {
+                unique_lock<mutex> lock(m);
+                cv.wait_for(lock, chrono::milliseconds(100), [this] { return quit; });
+                done = quit;
+                for (auto& b : buffers) b->drain(pending);
+            }
+
+            static const char* names[] = { "possession", "shot", "goal" };
+            for (const auto& e : pending) {
+                out << e.time << ',' << names[e.type] << ',' << (int)e.player << ','
+                    << (int)e.team << ',' << e.x << ',' << e.y << ',';
+                if (e.type == TelemetryEvent::SHOT) out << e.charge << ',' << e.speed;
+                else out << ',';
+                out << '\n';
+            }
+            pending.clear();
+        }
+    }
+
+    void writeHeatmaps() {
+        ofstream heatOut(heatmapPath.c_str());
+        if (!heatOut) {
+            cerr << "Failed to open " << heatmapPath << endl;
+            return;
+        }
+        // Sparse: only cells a player actually visited, counted in frames
+        heatOut << "player,team,row,col,frames\n";
+        for (int p = 0; p < MAX_PLAYERS; p++)
+            for (int r = 0; r < GRID_ROWS; r++)
+                for (int c = 0; c < GRID_COLS; c++)
+                    if (heat[p][r][c] > 0)
+                        heatOut << p << ',' << heatTeam[p] << ',' << r << ','
+                                << c << ',' << heat[p][r][c] << '\n';
+    }
+};
+
+Telemetry telemetry;
+// ===================================================
+
 // ====================== BALL =======================
 class Ball {
 public:
@@ -189,6 +741,7 @@ public:
         possessedBy = player;
         vx = 0;
         vy = 0;
+        telemetry.possession(player);
     }
     
     void startCharging() {
@@ -216,6 +769,7 @@ public:
         // Set ball velocity in arrow direction
         vx = dx * shotPower;
         vy = dy * shotPower;
+        telemetry.shot(shooter, chargePower, shotPower);
 
         // Push ball outside player radius in arrow direction
         x = shooter->x + dx * (shooter->radius + radius + 2);
@@ -226,13 +780,14 @@ public:
     }
 
 
-    void draw(SDL_Renderer* renderer) {
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-        drawFilledCircle(renderer, (int)x, (int)y, radius);
+    // now is SDL_GetTicks() for the frame being drawn
+    void draw(Canvas* canvas, Uint32 now) {
+        canvas->setColor(255, 255, 255, 255);
+        canvas->fillCircle((int)x, (int)y, radius);
         
         // Draw charge indicator
         if (isCharging && possessedBy) {
-            Uint32 chargeTime = SDL_GetTicks() - chargeStartTime;
+            Uint32 chargeTime = now - chargeStartTime;
             float chargePower = min(1.0f, (float)chargeTime / MAX_CHARGE_TIME);
             
             // Draw power bar
@@ -242,17 +797,17 @@ public:
             int barY = (int)y - radius - 20;
             
             // Background
-            SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
+            canvas->setColor(50, 50, 50, 255);
             SDL_Rect bgRect = {barX, barY, barWidth, barHeight};
-            SDL_RenderFillRect(renderer, &bgRect);
+            canvas->fillRect(bgRect);
             
             // Charge fill (green to red gradient based on power)
             int fillWidth = (int)(barWidth * chargePower);
             int r = (int)(255 * chargePower);
             int g = (int)(255 * (1.0f - chargePower));
-            SDL_SetRenderDrawColor(renderer, r, g, 0, 255);
+            canvas->setColor(r, g, 0, 255);
             SDL_Rect fillRect = {barX, barY, fillWidth, barHeight};
-            SDL_RenderFillRect(renderer, &fillRect);
+            canvas->fillRect(fillRect);
         }
     }
 };
@@ -273,20 +828,20 @@ public:
                ball.y >= rect.y && ball.y <= rect.y + rect.h;
     }
     
-    void draw(SDL_Renderer* renderer) {
+    void draw(Canvas* canvas) {
         // Draw goal zone with semi-transparent color
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        canvas->setBlendMode(SDL_BLENDMODE_BLEND);
         if (teamId == 1) {
-            SDL_SetRenderDrawColor(renderer, 255, 0, 0, 100); // Red for left goal
+            canvas->setColor(255, 0, 0, 100); // Red for left goal
         } else {
-            SDL_SetRenderDrawColor(renderer, 0, 0, 255, 100); // Blue for right goal
+            canvas->setColor(0, 0, 255, 100); // Blue for right goal
         }
-        SDL_RenderFillRect(renderer, &rect);
+        canvas->fillRect(rect);
         
         // Draw border
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-        SDL_RenderDrawRect(renderer, &rect);
+        canvas->setBlendMode(SDL_BLENDMODE_NONE);
+        canvas->setColor(255, 255, 255, 255);
+        canvas->drawRect(rect);
     }
 };
 // ===================================================
@@ -298,9 +853,9 @@ public:
     int score = 0;
     int activeIndex = 0;
 
-    void draw(SDL_Renderer* renderer) {
+    void draw(Canvas* canvas) {
         for (auto& p : players)
-            p.draw(renderer);
+            p.draw(canvas);
     }
 
     void deactivateAll() {
@@ -325,7 +880,7 @@ bool checkCollision(Player& p, Ball& b) {
 // ===================================================
 
 // ================= DRAW DIGIT =====================
-void drawDigit(SDL_Renderer* renderer, int digit, int x, int y, int size) {
+void drawDigit(Canvas* canvas, int digit, int x, int y, int size) {
     // Simple 7-segment style digit rendering
     bool segments[10][7] = {
         {1,1,1,1,1,1,0}, // 0
@@ -345,56 +900,519 @@ void drawDigit(SDL_Renderer* renderer, int digit, int x, int y, int size) {
     int w = size / 3;
     int h = size / 2;
     
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    canvas->setColor(255, 255, 255, 255);
     
     // Top horizontal
     if (segments[digit][0]) {
         SDL_Rect r = {x + w/3, y, w, h/5};
-        SDL_RenderFillRect(renderer, &r);
+        canvas->fillRect(r);
     }
     // Top right vertical
     if (segments[digit][1]) {
         SDL_Rect r = {x + w + w/3, y, w/5, h};
-        SDL_RenderFillRect(renderer, &r);
+        canvas->fillRect(r);
     }
     // Bottom right vertical
     if (segments[digit][2]) {
         SDL_Rect r = {x + w + w/3, y + h, w/5, h};
-        SDL_RenderFillRect(renderer, &r);
+        canvas->fillRect(r);
     }
     // Bottom horizontal
     if (segments[digit][3]) {
         SDL_Rect r = {x + w/3, y + 2*h - h/5, w, h/5};
-        SDL_RenderFillRect(renderer, &r);
+        canvas->fillRect(r);
     }
     // Bottom left vertical
     if (segments[digit][4]) {
         SDL_Rect r = {x, y + h, w/5, h};
-        SDL_RenderFillRect(renderer, &r);
+        canvas->fillRect(r);
     }
     // Top left vertical
     if (segments[digit][5]) {
         SDL_Rect r = {x, y, w/5, h};
-        SDL_RenderFillRect(renderer, &r);
+        canvas->fillRect(r);
     }
     // Middle horizontal
     if (segments[digit][6]) {
         SDL_Rect r = {x + w/3, y + h - h/10, w, h/5};
-        SDL_RenderFillRect(renderer, &r);
+        canvas->fillRect(r);
     }
 }
 
-void drawNumber(SDL_Renderer* renderer, int number, int x, int y, int size) {
+void drawNumber(Canvas* canvas, int number, int x, int y, int size) {
     string numStr = to_string(number);
     int spacing = size / 2;
     for (size_t i = 0; i < numStr.length(); i++) {
         int digit = numStr[i] - '0';
-        drawDigit(renderer, digit, x + i * spacing, y, size);
+        drawDigit(canvas, digit, x + i * spacing, y, size);
     }
 }
 // ===================================================
 
+// ===================== RECORDER ====================
+// Reads back each presented frame into a ring of preallocated buffers and
+// streams them to a Y4M file from a writer thread. The game thread only pays
+// for the readback (a memcpy with the CPU canvas); YUV conversion and disk I/O
+// happen on the writer. When the ring is full the frame is dropped instead of
+// stalling the game loop. Each capture is timestamped and the writer places it
+// on a constant FPS timeline, repeating the previous image over frames the
+// loop was too slow for or the ring dropped, so clips play back in real time.
+class Recorder {
+public:
+    static const int RING_SIZE = 4;
+    static const int FPS = 60;
+    bool recording = false;
+    int droppedFrames = 0;
+
+    ~Recorder() { stop(); }
+
+    bool start(const string& path) {
+        if (recording) return true;
+
+        out.open(path.c_str(), ios::binary);
+        if (!out) {
+            cerr << "Failed to open " << path << " for recording" << endl;
+            return false;
+        }
+        // Full range BT.601, 4:2:0
+        out << "YUV4MPEG2 W" << SCREEN_WIDTH << " H" << SCREEN_HEIGHT
+            << " F" << FPS << ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+
+        slots.assign(RING_SIZE, vector<Uint32>(SCREEN_WIDTH * SCREEN_HEIGHT));
+        slotTimes.assign(RING_SIZE, 0);
+        framesWritten = 0;
+        yuv.resize(SCREEN_WIDTH * SCREEN_HEIGHT * 3 / 2);
+        head = tail = count = 0;
+        droppedFrames = 0;
+        readbackFailures = 0;
+        quit = false;
+        writer = thread(&Recorder::writerLoop, this);
+        recording = true;
+        cout << "Recording to " << path << endl;
+        return true;
+    }
+
+    // Must be called after drawing and before SDL_RenderPresent
+    void capture(Canvas* canvas) {
+        if (!recording) return;
+
+        int slot;
+        {
+            lock_guard<mutex> lock(m);
+            if (count == RING_SIZE) {
+                droppedFrames++; // writer is behind, skip this frame
+                return;
+            }
+            slot = head;
+        }
+
+        // The writer never touches slots outside [tail, tail + count)
+        if (!canvas->readPixels(slots[slot].data())) {
+            // Leave the slot unqueued, the writer holds the previous image
+            droppedFrames++;
+            if (readbackFailures++ == 0)
+                cerr << "Frame readback failed: " << SDL_GetError() << endl;
+            return;
+        }
+        slotTimes[slot] = SDL_GetTicks();
+
+        {
+            lock_guard<mutex> lock(m);
+            head = (head + 1) % RING_SIZE;
+            count++;
+        }
+        cv.notify_one();
+    }
+
+    void stop() {
+        if (!recording) return;
+        {
+            lock_guard<mutex> lock(m);
+            quit = true;
+        }
+        cv.notify_one();
+        writer.join();
+        out.close();
+        recording = false;
+        cout << "Recording stopped (" << droppedFrames << " dropped frames)" << endl;
+    }
+
+private:
+    vector<vector<Uint32>> slots;
+    vector<Uint32> slotTimes; // SDL_GetTicks() of each capture
+    vector<Uint8> yuv; // writer thread scratch, holds the last written image
+    Uint32 firstTime = 0; // writer only
+    int framesWritten = 0; // writer only
+    int readbackFailures = 0;
+    ofstream out;
+    thread writer;
+    mutex m;
+    condition_variable cv;
+    int head = 0, tail = 0, count = 0;
+    bool quit = false;
+
+    void writerLoop() {
+        while (true) {
+            int slot;
+            {
+                unique_lock<mutex> lock(m);
+                cv.wait(lock, [this] { return count > 0 || quit; });
+                if (count == 0) return; // quit requested and ring drained
+                slot = tail;
+            }
+
+            if (framesWritten == 0) firstTime = slotTimes[slot];
+            int target = (int)((Uint64)(slotTimes[slot] - firstTime) * FPS / 1000);
+
+            // Captures faster than FPS land on an already written frame
+            if (target >= framesWritten) {
+                // Hold the previous image over the frames that were missed
+                while (framesWritten > 0 && framesWritten < target) writeFrame();
+                convertToYUV(slots[slot]);
+                writeFrame();
+            }
+
+            {
+                lock_guard<mutex> lock(m);
+                tail = (tail + 1) % RING_SIZE;
+                count--;
+            }
+        }
+    }
+
+    void writeFrame() {
+        out << "FRAME\n";
+        out.write((const char*)yuv.data(), yuv.size());
+        framesWritten++;
+    }
+
+    void convertToYUV(const vector<Uint32>& pixels) {
+        Uint8* Y = yuv.data();
+        Uint8* U = Y + SCREEN_WIDTH * SCREEN_HEIGHT;
+        Uint8* V = U + SCREEN_WIDTH * SCREEN_HEIGHT / 4;
+
+        for (int y = 0; y < SCREEN_HEIGHT; y += 2) {
+            for (int x = 0; x < SCREEN_WIDTH; x += 2) {
+                int sumR = 0, sumG = 0, sumB = 0;
+                // 2x2 block shares one chroma sample
+                for (int dy = 0; dy < 2; dy++) {
+                    for (int dx = 0; dx < 2; dx++) {
+                        Uint32 p = pixels[(y + dy) * SCREEN_WIDTH + x + dx];
+                        int r = (p >> 16) & 0xFF;
+                        int g = (p >> 8) & 0xFF;
+                        int b = p & 0xFF;
+                        Y[(y + dy) * SCREEN_WIDTH + x + dx] =
+                            (Uint8)((77 * r + 150 * g + 29 * b) >> 8);
+                        sumR += r; sumG += g; sumB += b;
+                    }
+                }
+                int r = sumR / 4, g = sumG / 4, b = sumB / 4;
+                int c = (y / 2) * (SCREEN_WIDTH / 2) + x / 2;
+                U[c] = (Uint8)(((-43 * r - 85 * g + 128 * b) >> 8) + 128);
+                V[c] = (Uint8)(((128 * r - 107 * g - 21 * b) >> 8) + 128);
+            }
+        }
+    }
+};
+// ===================================================
+
+// =================== FRAME STATS ===================
+// Average frame cost (excluding the SDL_Delay) and how much of it went into
+// capturing frames for the recorder
+class FrameStats {
+public:
+    static const int REPORT_INTERVAL = 300; // frames, ~5 seconds
+
+    void addFrame(Uint64 frameCounts, Uint64 captureCounts) {
+        frameTotal += frameCounts;
+        captureTotal += captureCounts;
+        frames++;
+    }
+
+    void report(int droppedFrames) {
+        if (frames < REPORT_INTERVAL) return;
+
+        double freq = (double)SDL_GetPerformanceFrequency();
+        double frameMs = frameTotal * 1000.0 / freq / frames;
+        double captureMs = captureTotal * 1000.0 / freq / frames;
+        cout << "frame " << frameMs << " ms, capture " << captureMs << " ms ("
+             << (frameMs > 0 ? captureMs * 100.0 / frameMs : 0) << "%), dropped "
+             << droppedFrames << endl;
+
+        frameTotal = captureTotal = 0;
+        frames = 0;
+    }
+
+private:
+    Uint64 frameTotal = 0, captureTotal = 0;
+    int frames = 0;
+};
+// ===================================================
+
+// =================== DRAW SCENE ====================
+void drawScene(Canvas* canvas, Goal& leftGoal, Goal& rightGoal,
+               Team& team1, Team& team2, Ball& ball,
+               int remainingTime, bool gameOver, Uint32 now) {
+    canvas->clear();
+    
+    // Draw background
+    if (canvas->hasBackground) {
+        canvas->drawBackground();
+    } else {
+        // Fallback to green if texture failed to load
+        canvas->setColor(0, 120, 0, 255);
+        canvas->clear();
+    }
+
+    // Draw goals
+    leftGoal.draw(canvas);
+    rightGoal.draw(canvas);
+    
+    team1.draw(canvas);
+    team2.draw(canvas);
+    ball.draw(canvas, now);
+    
+    // DRAW SCOREBOARD
+    // Background bar
+    canvas->setBlendMode(SDL_BLENDMODE_BLEND);
+    canvas->setColor(0, 0, 0, 180);
+    SDL_Rect scoreboardBg = {0, 0, SCREEN_WIDTH, 50};
+    canvas->fillRect(scoreboardBg);
+    canvas->setBlendMode(SDL_BLENDMODE_NONE);
+    
+    // Team 1 score (left side)
+    drawNumber(canvas, team1.score, 50, 10, 30);
+    
+    // Timer (center)
+    drawNumber(canvas, remainingTime, SCREEN_WIDTH/2 - 20, 10, 30);
+    
+    // Team 2 score (right side)
+    drawNumber(canvas, team2.score, SCREEN_WIDTH - 100, 10, 30);
+    
+    // GAME OVER SCREEN
+    if (gameOver) {
+        // Semi-transparent overlay
+        canvas->setBlendMode(SDL_BLENDMODE_BLEND);
+        canvas->setColor(0, 0, 0, 200);
+        SDL_Rect overlay = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+        canvas->fillRect(overlay);
+        
+        // Game Over box
+        canvas->setColor(40, 40, 40, 255);
+        SDL_Rect gameOverBox = {SCREEN_WIDTH/2 - 200, SCREEN_HEIGHT/2 - 150, 400, 300};
+        canvas->fillRect(gameOverBox);
+        
+        canvas->setColor(255, 255, 255, 255);
+        canvas->drawRect(gameOverBox);
+        
+        // Display final scores
+        int centerX = SCREEN_WIDTH / 2;
+        int centerY = SCREEN_HEIGHT / 2;
+        
+        // Team 1 final score
+        canvas->setColor(255, 0, 0, 255);
+        SDL_Rect team1Label = {centerX - 150, centerY - 80, 80, 60};
+        canvas->fillRect(team1Label);
+        drawNumber(canvas, team1.score, centerX - 130, centerY - 70, 40);
+        
+        // Team 2 final score
+        canvas->setColor(0, 0, 255, 255);
+        SDL_Rect team2Label = {centerX + 70, centerY - 80, 80, 60};
+        canvas->fillRect(team2Label);
+        drawNumber(canvas, team2.score, centerX + 90, centerY - 70, 40);
+        
+        // Winner text (simple representation)
+        canvas->setColor(255, 255, 255, 255);
+        if (team1.score > team2.score) {
+            // Red wins
+            SDL_Rect winnerBox = {centerX - 100, centerY + 50, 200, 40};
+            canvas->setColor(255, 0, 0, 255);
+            canvas->fillRect(winnerBox);
+        } else if (team2.score > team1.score) {
+            // Blue wins
+            SDL_Rect winnerBox = {centerX - 100, centerY + 50, 200, 40};
+            canvas->setColor(0, 0, 255, 255);
+            canvas->fillRect(winnerBox);
+        } else {
+            // Draw
+            SDL_Rect drawBox = {centerX - 100, centerY + 50, 200, 40};
+            canvas->setColor(128, 128, 128, 255);
+            canvas->fillRect(drawBox);
+        }
+        
+        canvas->setBlendMode(SDL_BLENDMODE_NONE);
+    }
+}
+// ===================================================
+
+// =================== RENDER CHECK ==================
+// Compares the CPU canvas against what the SDL renderer produced for the same
+// frame. Only RGB is compared, the window's alpha channel is meaningless.
+class RenderCheck {
+public:
+    static const int FRAMES = 300; // game loop iterations
+
+    int frames = 0;
+    int comparisons = 0;
+    int failedReadbacks = 0;
+    int edgeClipFrames = 0; // frames with a slanted arrow row crossing the top edge
+    long long mismatchedPixels = 0;
+    int maxDelta = 0;
+
+    void compare(const Uint32* expected, const Uint32* actual) {
+        for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
+            Uint32 e = expected[i], a = actual[i];
+            if (((e ^ a) & 0xFFFFFF) == 0) continue;
+
+            mismatchedPixels++;
+            for (int shift = 0; shift < 24; shift += 8) {
+                int delta = abs((int)((e >> shift) & 0xFF) - (int)((a >> shift) & 0xFF));
+                maxDelta = max(maxDelta, delta);
+            }
+        }
+        comparisons++;
+    }
+
+    // Scripted state for a check frame, the idle game only ever shows
+    // right-facing arrows, no charge bar and 0-0. Works on copies of the game
+    // objects; ball must be possessed by a player of t1 or t2 if at all.
+    // Triangle rows are only slanted when float truncation puts the two ends
+    // on different rows, which in practice happens where a triangle crosses
+    // y = 0. Those rows go through the clipped line path.
+    static bool hasSlantedRowAcrossTop(SDL_Point p1, SDL_Point p2, SDL_Point p3) {
+        bool found = false;
+        forEachTriangleRow(p1, p2, p3, [&](SDL_Point a, SDL_Point b) {
+            if (a.y != b.y && min(a.y, b.y) < 0 && max(a.y, b.y) >= 0) found = true;
+        });
+        return found;
+    }
+
+    static bool hasSlantedRowAcrossTop(const Player& p) {
+        SDL_Point tip, left, right;
+        p.arrowPoints(tip, left, right);
+        return hasSlantedRowAcrossTop(tip, left, right);
+    }
+
+    // Inside an arrow the next row usually paints over what the clipped row
+    // drew. These free-form triangles straddle the top edge and have a
+    // slanted row that visibly differs when it isn't clipped the way SDL
+    // clips it. Drawn on both canvases after the scene.
+    static void drawEdgeProbes(Canvas* canvas, int frame) {
+        static const SDL_Point probes[][3] = {
+            { {423, -25}, {364, 19}, {201, -26} }, { {486, 19}, {392, -15}, {319, -31} },
+            { {230, 16}, {248, 8}, {367, -19} }, { {304, -7}, {461, -14}, {398, 14} },
+            { {228, -7}, {360, 3}, {391, -16} }, { {357, -16}, {466, 9}, {499, -14} },
+            { {408, 27}, {205, -12}, {333, -14} }, { {280, -27}, {340, -35}, {387, 24} },
+            { {336, -24}, {458, -8}, {249, 18} }, { {363, -10}, {219, 25}, {248, -2} },
+            { {489, 32}, {206, -13}, {403, -25} }, { {484, -16}, {377, 38}, {283, -29} },
+            { {484, -2}, {209, -24}, {427, 21} }, { {283, 16}, {420, -16}, {279, 30} },
+            { {344, 1}, {466, -7}, {305, 14} }, { {475, 19}, {321, 23}, {232, -29} }
+        };
+        static const int PROBE_COUNT = sizeof(probes) / sizeof(probes[0]);
+
+        // One per frame, overlapping probes would paint over each other's
+        // clipped rows
+        const SDL_Point* p = probes[frame % PROBE_COUNT];
+        canvas->setBlendMode(SDL_BLENDMODE_NONE);
+        canvas->setColor(255, 0, 255, 255);
+        canvas->fillTriangle(p[0], p[1], p[2]);
+    }
+
+    // Returns true if an edge-clipped slanted row was staged
+    static bool stage(int frame, Team& t1, Team& t2, Ball& ball,
+                      int& remainingTime, Uint32& now) {
+        // The 8 directions keyboard input produces, then arbitrary angles
+        static const int dirs[8][2] = {
+            {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}
+        };
+        Team* teams[2] = { &t1, &t2 };
+        for (int t = 0; t < 2; t++) {
+            vector<Player>& players = teams[t]->players;
+            for (size_t i = 0; i < players.size(); i++) {
+                Player& p = players[i];
+                int k = frame + (int)i * 3 + t * 5;
+                p.active = true;
+                p.x = p.radius + (k * 37 + (int)i * 131) % (SCREEN_WIDTH - 2 * p.radius);
+                p.y = p.radius + (k * 53 + t * 97) % (SCREEN_HEIGHT - 2 * p.radius);
+                if (frame % 2 == 0) {
+                    p.updateDirection(dirs[k % 8][0], dirs[k % 8][1]);
+                } else {
+                    float angle = k * 0.37f;
+                    p.dirX = cos(angle);
+                    p.dirY = sin(angle);
+                }
+            }
+        }
+
+        // Point one arrow out over the top edge, searching for a position
+        // and angle whose arrow has a slanted row crossing it
+        Player& edgePlayer = t1.players[0];
+        bool edgeClip = false;
+        for (int k = 0; k < 20000 && !edgeClip; k++) {
+            int step = frame * 131 + k;
+            float angle = -(float)M_PI / 2 + (step % 97) * 0.013f - 0.63f;
+            edgePlayer.dirX = cos(angle);
+            edgePlayer.dirY = sin(angle);
+            edgePlayer.x = 100 + (step * 7) % (SCREEN_WIDTH - 200);
+            edgePlayer.y = 20 + (step / 97) % 60;
+            edgeClip = hasSlantedRowAcrossTop(edgePlayer);
+        }
+
+        // Charge from 0 (empty fill bar) past the maximum, or a free ball
+        Player& carrier = teams[frame % 2]->players[frame % teams[frame % 2]->players.size()];
+        ball.chargeStartTime = 1000;
+        now = ball.chargeStartTime + (frame % 12) * ball.MAX_CHARGE_TIME / 10;
+        if (frame % 4 == 3) {
+            ball.possessedBy = nullptr;
+            ball.isCharging = false;
+            ball.x = (frame * 71) % SCREEN_WIDTH;
+            ball.y = (frame * 43) % SCREEN_HEIGHT;
+        } else {
+            ball.possessedBy = &carrier;
+            ball.isCharging = true;
+            ball.update();
+        }
+
+        // Multi-digit scores, with a draw every fifth frame
+        t1.score = 10 + (frame * 7) % 110;
+        t2.score = frame % 5 == 0 ? t1.score : 10 + (frame * 13) % 140;
+        remainingTime = frame % 61;
+        return edgeClip;
+    }
+
+    bool passed() const {
+        return comparisons > 0 && failedReadbacks == 0 && mismatchedPixels == 0;
+    }
+
+    void report() const {
+        cout << "Render check: " << frames << " frames (" << comparisons
+             << " comparisons, " << failedReadbacks << " failed readbacks, "
+             << edgeClipFrames << " with edge-clipped arrow rows), " << mismatchedPixels
+             << " mismatched pixels, max channel delta " << maxDelta
+             << (passed() ? " (PASS)" : " (FAIL)") << endl;
+    }
+};
+// ===================================================
+
 int main(int argc, char* argv[]) {
+    // Command line: --record <file.y4m> starts recording at launch,
+    // --stats prints frame stats even when not recording,
+    // --telemetry <file.csv> logs match events and player heatmaps,
+    // --renderer sdl|cpu picks the render backend (default: cpu when SDL
+    // only has its software renderer),
+    // --render-check compares both backends for a few seconds and exits
+    string recordPath, telemetryPath, rendererName;
+    bool showStats = false;
+    bool renderCheck = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) recordPath = argv[++i];
+        else if (arg == "--telemetry" && i + 1 < argc) telemetryPath = argv[++i];
+        else if (arg == "--renderer" && i + 1 < argc) rendererName = argv[++i];
+        else if (arg == "--stats") showStats = true;
+        else if (arg == "--render-check") renderCheck = true;
+    }
+
     SDL_Init(SDL_INIT_VIDEO);
     IMG_Init(IMG_INIT_PNG);
     TTF_Init();
@@ -405,19 +1423,80 @@ int main(int argc, char* argv[]) {
         SCREEN_WIDTH, SCREEN_HEIGHT, 0
     );
 
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    
-    // Load background texture
-    SDL_Texture* backgroundTexture = IMG_LoadTexture(renderer, "Football_field.png");
-    if (!backgroundTexture) {
-        cerr << "Failed to load football_field.png: " << IMG_GetError() << endl;
+    // The render check compares against SDL's software renderer, the path the
+    // CPU backend replaces, not whatever GPU the machine happens to have
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1,
+        renderCheck ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED);
+    if (!renderer && !renderCheck) {
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+    }
+
+    if (!renderer) {
+        cerr << "Failed to create renderer: " << SDL_GetError() << endl;
+        SDL_DestroyWindow(window);
+        TTF_Quit();
+        IMG_Quit();
+        SDL_Quit();
+        return 1;
+    }
+
+    // Pick the render backend
+    if (!rendererName.empty() && rendererName != "cpu" && rendererName != "sdl") {
+        cerr << "Unknown renderer '" << rendererName << "', expected sdl or cpu" << endl;
+        rendererName.clear();
+    }
+    SDL_RendererInfo rendererInfo = {};
+    if (SDL_GetRendererInfo(renderer, &rendererInfo) != 0) {
+        rendererInfo.name = "unknown";
+    }
+    bool useCpu = rendererName == "cpu" ||
+        (rendererName.empty() && (rendererInfo.flags & SDL_RENDERER_SOFTWARE));
+
+    unique_ptr<SdlCanvas> sdlCanvas(new SdlCanvas(renderer));
+    unique_ptr<CpuCanvas> cpuCanvas;
+    if (useCpu || renderCheck) {
+        cpuCanvas.reset(new CpuCanvas(renderer));
+        if (!cpuCanvas->ok()) {
+            cpuCanvas.reset();
+            if (renderCheck) {
+                // A check that can't run must not pass
+                cerr << "Render check needs the CPU canvas, aborting" << endl;
+                sdlCanvas.reset();
+                SDL_DestroyRenderer(renderer);
+                SDL_DestroyWindow(window);
+                TTF_Quit();
+                IMG_Quit();
+                SDL_Quit();
+                return 1;
+            }
+            useCpu = false;
+        }
+    }
+    Canvas* canvas = useCpu ? (Canvas*)cpuCanvas.get() : sdlCanvas.get();
+    cout << "Renderer: " << rendererInfo.name << (useCpu ? " (cpu rasterizer)" : "") << endl;
+
+    // Load background texture, into both canvases only when checking
+    Canvas* checkCanvas = !renderCheck ? nullptr
+        : canvas == sdlCanvas.get() ? (Canvas*)cpuCanvas.get() : (Canvas*)sdlCanvas.get();
+    for (Canvas* c : { canvas, checkCanvas }) {
+        if (c && !c->loadBackground("Football_field.png")) {
+            cerr << "Failed to load football_field.png: " << IMG_GetError() << endl;
+        }
     }
 
+    RenderCheck check;
+    vector<Uint32> reference;
+    if (renderCheck) reference.resize(SCREEN_WIDTH * SCREEN_HEIGHT);
+
     bool running = true;
     SDL_Event event;
     const Uint8* keystate;
 
     int speed = 5;
+
+    Recorder recorder;
+    FrameStats frameStats;
+    if (!recordPath.empty()) recorder.start(recordPath);
     
     // ================= GAME STATE ===================
     Uint32 matchStartTime = SDL_GetTicks();
@@ -451,10 +1530,22 @@ int main(int argc, char* argv[]) {
     team1.players[team1.activeIndex].active = true;
     team2.players[team2.activeIndex].active = true;
 
+    for (size_t i = 0; i < team1.players.size(); i++) {
+        team1.players[i].id = i;
+        team1.players[i].team = 1;
+    }
+    for (size_t i = 0; i < team2.players.size(); i++) {
+        team2.players[i].id = team1.players.size() + i;
+        team2.players[i].team = 2;
+    }
+    if (!telemetryPath.empty()) telemetry.start(telemetryPath);
+
     Ball ball(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
 
     // ================= GAME LOOP ====================
     while (running) {
+        Uint64 frameStart = SDL_GetPerformanceCounter();
+
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT)
                 running = false;
@@ -474,6 +1565,13 @@ int main(int argc, char* argv[]) {
 
                     case SDLK_SPACE: team1.activateNext(); break;
                     case SDLK_RIGHTBRACKET: team2.activateNext(); break;
+
+                    // Toggle recording
+                    case SDLK_F9:
+                        if (event.key.repeat) break;
+                        if (recorder.recording) recorder.stop();
+                        else recorder.start("capture_" + to_string(SDL_GetTicks()) + ".y4m");
+                        break;
                 }
             }
         }
@@ -545,6 +1643,9 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        telemetry.samplePositions(team1.players);
+        telemetry.samplePositions(team2.players);
+
         // BALL
         ball.update();
         ball.wallCollision();
@@ -572,6 +1673,7 @@ int main(int argc, char* argv[]) {
         if (!gameOver) {
             if (leftGoal.checkBallInside(ball)) {
                 team2.score++; // Team 2 scores in left goal
+                telemetry.goal(2, ball.x, ball.y);
                 // Reset ball
                 ball.x = SCREEN_WIDTH / 2;
                 ball.y = SCREEN_HEIGHT / 2;
@@ -581,6 +1683,7 @@ int main(int argc, char* argv[]) {
                 ball.isCharging = false;
             } else if (rightGoal.checkBallInside(ball)) {
                 team1.score++; // Team 1 scores in right goal
+                telemetry.goal(1, ball.x, ball.y);
                 // Reset ball
                 ball.x = SCREEN_WIDTH / 2;
                 ball.y = SCREEN_HEIGHT / 2;
@@ -599,110 +1702,75 @@ int main(int argc, char* argv[]) {
         if (elapsedTime >= MATCH_DURATION && !gameOver) {
             gameOver = true;
             remainingTime = 0;
+            telemetry.endMatch();
         }
 
         // RENDER
-        SDL_RenderClear(renderer);
-        
-        // Draw background
-        if (backgroundTexture) {
-            SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL);
-        } else {
-            // Fallback to green if texture failed to load
-            SDL_SetRenderDrawColor(renderer, 0, 120, 0, 255);
-            SDL_RenderClear(renderer);
-        }
-
-        // Draw goals
-        leftGoal.draw(renderer);
-        rightGoal.draw(renderer);
-        
-        team1.draw(renderer);
-        team2.draw(renderer);
-        ball.draw(renderer);
-        
-        // DRAW SCOREBOARD
-        // Background bar
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
-        SDL_Rect scoreboardBg = {0, 0, SCREEN_WIDTH, 50};
-        SDL_RenderFillRect(renderer, &scoreboardBg);
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
-        
-        // Team 1 score (left side)
-        drawNumber(renderer, team1.score, 50, 10, 30);
-        
-        // Timer (center)
-        drawNumber(renderer, remainingTime, SCREEN_WIDTH/2 - 20, 10, 30);
-        
-        // Team 2 score (right side)
-        drawNumber(renderer, team2.score, SCREEN_WIDTH - 100, 10, 30);
-        
-        // GAME OVER SCREEN
-        if (gameOver) {
-            // Semi-transparent overlay
-            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 200);
-            SDL_Rect overlay = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
-            SDL_RenderFillRect(renderer, &overlay);
-            
-            // Game Over box
-            SDL_SetRenderDrawColor(renderer, 40, 40, 40, 255);
-            SDL_Rect gameOverBox = {SCREEN_WIDTH/2 - 200, SCREEN_HEIGHT/2 - 150, 400, 300};
-            SDL_RenderFillRect(renderer, &gameOverBox);
-            
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-            SDL_RenderDrawRect(renderer, &gameOverBox);
-            
-            // Display final scores
-            int centerX = SCREEN_WIDTH / 2;
-            int centerY = SCREEN_HEIGHT / 2;
-            
-            // Team 1 final score
-            SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-            SDL_Rect team1Label = {centerX - 150, centerY - 80, 80, 60};
-            SDL_RenderFillRect(renderer, &team1Label);
-            drawNumber(renderer, team1.score, centerX - 130, centerY - 70, 40);
-            
-            // Team 2 final score
-            SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
-            SDL_Rect team2Label = {centerX + 70, centerY - 80, 80, 60};
-            SDL_RenderFillRect(renderer, &team2Label);
-            drawNumber(renderer, team2.score, centerX + 90, centerY - 70, 40);
-            
-            // Winner text (simple representation)
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-            if (team1.score > team2.score) {
-                // Red wins
-                SDL_Rect winnerBox = {centerX - 100, centerY + 50, 200, 40};
-                SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-                SDL_RenderFillRect(renderer, &winnerBox);
-            } else if (team2.score > team1.score) {
-                // Blue wins
-                SDL_Rect winnerBox = {centerX - 100, centerY + 50, 200, 40};
-                SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
-                SDL_RenderFillRect(renderer, &winnerBox);
-            } else {
-                // Draw
-                SDL_Rect drawBox = {centerX - 100, centerY + 50, 200, 40};
-                SDL_SetRenderDrawColor(renderer, 128, 128, 128, 255);
-                SDL_RenderFillRect(renderer, &drawBox);
+        Uint32 now = SDL_GetTicks();
+
+        if (renderCheck) {
+            // Scripted copy of the game state through both backends, with and
+            // without the game-over overlay
+            Team checkTeam1 = team1, checkTeam2 = team2;
+            Ball checkBall = ball;
+            int checkTime;
+            Uint32 checkNow;
+            if (RenderCheck::stage(check.frames, checkTeam1, checkTeam2, checkBall,
+                                   checkTime, checkNow))
+                check.edgeClipFrames++;
+
+            for (int pass = 0; pass < 2; pass++) {
+                bool overlay = pass == 1;
+                drawScene(sdlCanvas.get(), leftGoal, rightGoal, checkTeam1, checkTeam2,
+                          checkBall, checkTime, overlay, checkNow);
+                RenderCheck::drawEdgeProbes(sdlCanvas.get(), check.frames);
+                if (!sdlCanvas->readPixels(reference.data())) {
+                    check.failedReadbacks++;
+                    continue;
+                }
+                drawScene(cpuCanvas.get(), leftGoal, rightGoal, checkTeam1, checkTeam2,
+                          checkBall, checkTime, overlay, checkNow);
+                RenderCheck::drawEdgeProbes(cpuCanvas.get(), check.frames);
+                check.compare(reference.data(), cpuCanvas->pixels.data());
             }
-            
-            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+            if (++check.frames >= RenderCheck::FRAMES) running = false;
         }
 
+        drawScene(canvas, leftGoal, rightGoal, team1, team2, ball, remainingTime, gameOver, now);
+        canvas->finish();
+
+
+        // Capture has to happen before present, the back buffer is undefined after it
+        Uint64 captureStart = SDL_GetPerformanceCounter();
+        recorder.capture(canvas);
+        Uint64 captureEnd = SDL_GetPerformanceCounter();
+
         SDL_RenderPresent(renderer);
+
+        if (showStats || recorder.recording) {
+            frameStats.addFrame(SDL_GetPerformanceCounter() - frameStart,
+                                captureEnd - captureStart);
+            frameStats.report(recorder.droppedFrames);
+        }
         SDL_Delay(16);
     }
 
-    if (backgroundTexture) {
-        SDL_DestroyTexture(backgroundTexture);
+    recorder.stop();
+    telemetry.stop();
+
+    int exitCode = 0;
+    if (renderCheck) {
+        check.report();
+        exitCode = check.passed() ? 0 : 1;
     }
+
+    // Textures have to go before the renderer that owns them
+    cpuCanvas.reset();
+    sdlCanvas.reset();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     TTF_Quit();
     IMG_Quit();
     SDL_Quit();
-    return 0;
+    return exitCode;
 }